@@ -43,6 +43,8 @@ using std::string;
 #define String string
 #endif
 #include <stack>
+#include "reloc.h"
+#include "srec.h"
 //--------------------
 #define stricmp   strcasecmp
 #define strcmpi   strcasecmp
@@ -101,6 +103,9 @@ void REMOVECR(char *line);
 #define INV_OP_TYPE_MIX      0x308
 #define INV_RELATIVE		 0x309
 #define INV_ABSOLUTE         0x30A
+#define INV_EXTERNAL         0x30B
+#define NOT_RELOCATABLE      0x30C
+#define NEED_RELOCATABLE     0x30D
 #define MINOR		         0x200
 #define INV_SIZE_CODE	     0x201
 #define INV_QUICK_CONST      0x202
@@ -128,6 +133,7 @@ void REMOVECR(char *line);
 #define DO_EXPECTED          0x109
 #define FORWARD_REF          0x10A
 #define LABEL_TOO_LONG       0x10B
+#define LINE_TOO_LONG        0x10C
 #define SEVERITY	         0xF00
 #define BACKREF	              0x01
 #define REDEFINABLE           0x02	
@@ -170,6 +176,14 @@ void REMOVECR(char *line);
 #define SIGCHARS 33
 #define MAX_ARGS 36       // maximum number of macro arguments
 #define ARG_SIZE 256      // maximum size of each argument
+#define LINE_SIZE 1024    // maximum size of a source line
+#define OPTION_FLAGS 20   // option flags kept by saveFlags()
+#define CYCLE_WIDTH 10    // columns of the clock cycles in the listing
+
+/* What the opcode field of a line is, from lineKind() */
+enum { LINE_OTHER, LINE_EMPTY, LINE_COMMENT, LINE_OPT, LINE_ORG,
+       LINE_IFC, LINE_IFNC, LINE_IFEQ, LINE_IFNE, LINE_IFLT, LINE_IFLE,
+       LINE_IFGT, LINE_IFGE, LINE_ENDC };
 
 /* Structure for operand descriptors */
 struct opDescriptor
@@ -184,6 +198,7 @@ struct opDescriptor
                 // BYTE_SIZE, WORD_SIZE, LONG_SIZE
                 // Also used to prevent MOVEQ, ADDQ & SUBQ optimizations (see OPPARSE.CPP)
   bool backRef;	// True if data field is known on first pass
+  int  section;	// Section of a relative data field, or RELOC_NONE (see RELOC.CPP)
 };
 
 // Expression value, or partial value
@@ -191,14 +206,19 @@ struct exprVal
 {
 	int value;
 	bool isRelative;
+	int section;	// Section of a relative value, or RELOC_IMPORT + n for external symbol n
 };
 
 /* Structure for a symbol table entry */
+/* Entries are allocated from a pool and the names are interned in a
+   separate name pool, see SYMBOL.CPP */
 typedef struct symbolEntry {
 	exprVal value;			/* 32-bit value of the symbol */
-	struct symbolEntry *next;	/* Pointer to next symbol in linked list */
+	const char *name;		/* Name (interned, NULL terminated) */
+	unsigned int hash;		/* Hash of the name */
 	char flags;			/* Flags (see below) */
-	char name[SIGCHARS+1];		/* Name */
+	int seq;			/* Line that first defined it (single pass) */
+	int relaxPass;			/* Run of pass 1 that last defined it */
 	} symbolDef;
 
 
@@ -228,6 +248,46 @@ typedef struct {
 			/* Routine to be called if parseFlag is FALSE */
 	} instruction;
 
+
+/* Structure for a source file held in memory (see SOURCE.CPP) */
+typedef struct {
+	char *text;		/* Contents of file, NULL terminated */
+	int size;		/* Size of file in bytes */
+	int *lineStart;		/* Offset of each line, plus end of file */
+	int lineCount;		/* Number of lines */
+	} sourceFile;
+
+/* Position of the next line to assemble in a source file */
+typedef struct {
+	sourceFile *file;	/* File being read */
+	int next;		/* Index of next line */
+	} sourceReader;
+
+/* State at the start of a line, kept by the single pass engine so the
+   line can be assembled again once its forward references are known
+   (see FIXUP.CPP) */
+typedef struct {
+	bool forwardRef;	/* Flags of the enclosing line */
+	bool leaf;
+	int seq;		/* Number of the line in assembly order */
+	int error;		/* Error code passed in to assemble() */
+	int loc;
+	bool isRelative;
+	int lineNum, lineNumL68;
+	bool offsetMode, showEqual;
+	bool listFlag, CEXflag, WARflag, BITflag;
+	bool continuation, skipList, printCond;
+	char globalLabel[SIGCHARS+1];
+	long listPos;		/* Start of its listing, -1 if not known */
+	int dataPos;		/* Start of its object code */
+	int errorCount, warningCount;
+	} fixupFrame;
+
+/* Kinds of object code held by the single pass engine */
+#define FIX_DATA	0	/* output() */
+#define FIX_BLOCK	1	/* outputBlock() */
+#define FIX_BYTES	2	/* outputBytes() */
+
 /* Addressing mode codes/bitmasks */
 #define DnDirect               0x00001
 #define AnDirect               0x00002
@@ -249,17 +309,76 @@ typedef struct {
 
 enum tabTypes{ Assembly, Fixed };
 
-extern bool listFlag;	       // True if a listing is desired
-extern bool objFlag;	       // True if an S-Record object code file is desired
-extern bool binFlag;	       // True if binary output is desired
-extern bool CEXflag;	       // True is Constants are to be EXpanded
-extern bool BITflag;           // True to assemble bitfield instructions
-extern bool CREflag;           // true adds symbol table to listing
-extern bool MEXflag;           // true expands macro calls in listing
-extern bool SEXflag;           // true expands structured code in listing
-extern bool WARflag;           // true shows Warnings during assembly
-extern bool noFileName;        // true indicates no name for current source file
-extern bool optimize;		   // True enables optimizations
+extern thread_local bool listFlag;	       // True if a listing is desired
+extern thread_local bool objFlag;	       // True if an S-Record object code file is desired
+extern thread_local bool binFlag;	       // True if binary output is desired
+extern thread_local bool CEXflag;	       // True is Constants are to be EXpanded
+extern thread_local bool BITflag;           // True to assemble bitfield instructions
+extern thread_local bool CREflag;           // true adds symbol table to listing
+extern thread_local bool MEXflag;           // true expands macro calls in listing
+extern thread_local bool SEXflag;           // true expands structured code in listing
+extern thread_local bool WARflag;           // true shows Warnings during assembly
+extern thread_local bool noFileName;        // true indicates no name for current source file
+extern thread_local bool optimize;		   // True enables optimizations
+extern thread_local bool singlePassFlag;     // true assembles in one pass with a fixup list
+extern thread_local bool relaxFlag;          // true picks branch sizes by relaxation
+extern thread_local unsigned int optRules;   // peephole rules in use when optimize is true
+extern thread_local bool optReportFlag;      // true shows what the peephole rules saved
+extern thread_local bool relocFlag;          // true writes a relocatable object instead of .S68 and .bin
+extern thread_local bool precompFlag;        // true writes a precompiled include instead of .S68 and .bin
+extern thread_local bool cyclesFlag;         // true lists the clock cycles of each instruction
+extern thread_local bool cycleReportFlag;    // true shows the loops that take the most clock cycles
+extern thread_local int cycleCpu;            // 68000 or 68008, the processor cycles are counted for
+extern thread_local bool timesFlag;          // true shows the time each phase of assembly took
+extern thread_local bool statsFlag;          // true counts what the assembler does, see STATS.CPP
+extern thread_local bool statsJsonFlag;      // true shows the counts as JSON
+extern thread_local int srecLength;          // data bytes in each S-record of the .S68 file
+
+/* Counters for --stats. Index [pass2] of each pair counts pass 1
+   (all runs of it) and pass 2, or the one pass of a single pass
+   assembly. Build with -DNOSTATS to leave the counting out. */
+struct asmStatistics {
+	double time[4];		/* load, pass 1, pass 2, output in ms */
+	int pass1Runs;		/* runs of pass 1 */
+	long lines[2];		/* lines assembled, with macro and include lines */
+	long lookups[2];	/* lookup() calls */
+	long lookupHits[2];	/* lookup() calls that found the symbol */
+	long lookupProbes[2];	/* hash table slots lookup() looked at */
+	long instLookups[2];	/* instLookup() calls */
+	long macroFallbacks[2];	/* instLookup() calls looked up as macros */
+	long evals[2];		/* eval() calls */
+	long evalRuns[2];	/* expressions run from their compiled program */
+	long macroCalls[2];	/* macro expansions */
+	long macroLines[2];	/* lines expanded from macro bodies */
+	long outBytes[4];	/* listing, S-record, binary, relocatable object */
+};
+extern thread_local asmStatistics asmStats;
+
+#define STATS_LIST	0	/* asmStatistics.outBytes */
+#define STATS_SREC	1
+#define STATS_BIN	2
+#define STATS_RELOC	3
+
+#ifdef NOSTATS
+#define STAT(counter)
+#define STAT_ADD(counter, n)
+#define STAT_OUT(writer, n)
+#else
+#define STAT(counter)		do { if (statsFlag) asmStats.counter[pass2]++; } while (0)
+#define STAT_ADD(counter, n)	do { if (statsFlag) asmStats.counter[pass2] += (n); } while (0)
+#define STAT_OUT(writer, n)	do { if (statsFlag) asmStats.outBytes[writer] = (n); } while (0)
+#endif
+
+// Peephole optimizer rules, see PEEPHOLE.CPP
+#define OPT_MOVEQ       0x0001  // MOVE.L #n,Dn -> MOVEQ
+#define OPT_QUICK       0x0002  // ADD/SUB/ADDA/SUBA #1..8 -> ADDQ/SUBQ
+#define OPT_CLR         0x0004  // MOVE.B/W #0,Dn -> CLR
+#define OPT_SUBA        0x0008  // MOVEA #0,An -> SUBA.L An,An
+#define OPT_LEA         0x0010  // LEA d(An),An -> ADDQ/SUBQ
+#define OPT_TST         0x0020  // CMP/CMPI #0,<ea> -> TST
+#define OPT_ABSSHORT    0x0040  // xxx.L -> xxx.W
+#define OPT_ZERODISP    0x0080  // 0(An) -> (An)
+#define OPT_DEFAULT     (OPT_MOVEQ | OPT_QUICK | OPT_ABSSHORT | OPT_ZERODISP)
 
 
 
@@ -0,0 +1,367 @@
+/***********************************************************************
+ *
+ *		GENSRC.CPP
+ *		Synthetic QL source generator for the 68000 Assembler
+ *		benchmarks
+ *
+ *    Writes a set of large sources that each stress one part of the
+ *    assembler, for runbench to time:
+ *
+ *		mix.x68     every flavor of every instruction in instTable[]
+ *		            with each size and addressing mode it allows,
+ *		            repeated
+ *		incl.x68    a deep tree of include files with code and
+ *		            equates in every file
+ *		macro.x68   nested macros with arguments, \@ labels and
+ *		            IFARG, called a few thousand times
+ *		struct.x68  nested IF/WHILE/FOR/REPEAT/DBLOOP structured
+ *		            code
+ *		data.x68    large INCBIN files and DCB blocks
+ *		expr.x68    equates and DC tables whose every operand
+ *		            is an expression of symbols, local labels
+ *		            and constants, in absolute code that
+ *		            includes the OFFSET structures of
+ *		            offsets.x68, which runbench precompiles
+ *		cond.x68    conditional assembly, mostly lines in blocks
+ *		            that are skipped
+ *
+ *    The scale multiplies the size of every file, scale 1 gives a
+ *    few tens of thousands of lines in all.
+ *
+ *	 Usage: gensrc [directory [scale]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include "../asm.h"
+
+extern instruction instTable[];
+extern int tableSize;
+
+static string dir;              // where the files go
+
+//-------------------------------------------------------
+static FILE *create(const char *name)
+{
+  string path = dir + "/" + name;
+  FILE *f = fopen(path.c_str(), "w");
+
+  if (!f) {
+    fprintf(stderr, "Can't create %s\n", path.c_str());
+    exit(1);
+  }
+  return f;
+}
+
+//-------------------------------------------------------
+// An operand in addressing mode 'mode'. dest picks other registers
+// so source and destination differ. label is the label of the line,
+// used for the PC relative modes.
+static const char *operand(int mode, bool dest, const char *label)
+{
+  static char text[64];
+
+  switch (mode) {
+    case DnDirect:   return dest ? "d3" : "d1";
+    case AnDirect:   return dest ? "a2" : "a1";
+    case AnInd:      return dest ? "(a2)" : "(a1)";
+    case AnIndPost:  return dest ? "(a2)+" : "(a1)+";
+    case AnIndPre:   return dest ? "-(a2)" : "-(a1)";
+    case AnIndDisp:  return dest ? "8(a2)" : "4(a1)";
+    case AnIndIndex: return dest ? "8(a2,d4.l)" : "4(a1,d2.w)";
+    case AbsShort:   return "$20";
+    case AbsLong:    return "$12340.L";
+    case PCDisp:     return label;
+    case PCIndex:    sprintf(text, "%s(pc,d2.w)", label); return text;
+    case IMMEDIATE:  return "#4";
+    case SRDirect:   return "sr";
+    case CCRDirect:  return "ccr";
+    case USPDirect:  return "usp";
+  }
+  return NULL;                  // not one the generator knows
+}
+
+//-------------------------------------------------------
+// One line for each size and source mode of each flavor, with the
+// destination modes taken in turn. Returns the number of lines.
+static int instructionMix(FILE *f, int rep)
+{
+  const char *sizes = "BWLS";
+  int i, j, s, m, d, lines = 0;
+  char label[32], sizeCode[4];
+
+  for (i=0; i<tableSize; i++) {
+    instruction *inst = &instTable[i];
+    if (!inst->parseFlag)
+      continue;
+    for (j=0; j<inst->flavorCount; j++) {
+      flavor *fl = &inst->flavorPtr[j];
+      if (fl->exec == bitField)
+        continue;               // needs {offset:width} operands
+      // branch targets are labels, absolute ones are errors in QL code
+      int source = (fl->exec == branch) ? PCDisp : fl->source;
+      int dest = (fl->exec == dbcc) ? PCDisp : fl->dest;
+      d = 0;
+      for (s=-1; s<4; s++) {
+        if (s < 0 ? fl->sizes != 0 : !(fl->sizes & (1 << s)))   // B W L S
+          continue;
+        if (s >= 0)
+          sprintf(sizeCode, ".%c", sizes[s]);
+        else
+          sizeCode[0] = '\0';
+        for (m=1; m<=VBRDirect; m<<=1) {
+          if (source ? !(source & m) : m != 1)
+            continue;
+          sprintf(label, "M%d_%d", rep, lines);
+          const char *src = source ? operand(m, false, label) : "";
+          if (!src)
+            continue;
+          const char *dst = "";
+          if (dest) {
+            // next destination mode the generator knows, round robin
+            for (int k=0; k<18 && !*dst; k++) {
+              int mode = 1 << d;
+              d = (d+1) % 18;
+              if ((dest & mode) && operand(mode, true, label))
+                dst = operand(mode, true, label);
+            }
+            if (!*dst)
+              continue;
+          }
+          fprintf(f, "%s\t%s%s\t%s%s%s\n", label, inst->mnemonic, sizeCode,
+                  src, dest ? "," : "", dst);
+          lines++;
+        }
+      }
+    }
+  }
+  return lines;
+}
+
+//-------------------------------------------------------
+static void mixFile(int scale)
+{
+  FILE *f = create("mix.x68");
+  int lines = 0;
+
+  fprintf(f, "* every instruction flavor, %d times\n", 10 * scale);
+  for (int rep=0; rep<10*scale; rep++)
+    lines += instructionMix(f, rep);
+  // a starting address, which incl.x68 must not get from the server
+  fprintf(f, "\tEND\t$1000\n");
+  fclose(f);
+  printf("mix.x68     %7d instruction lines\n", lines);
+}
+
+//-------------------------------------------------------
+// File name of include file n at the given depth
+static string includeName(int depth, int n)
+{
+  char name[32];
+
+  sprintf(name, "inc%d_%d.x68", depth, n);
+  return name;
+}
+
+// Writes include file n at depth d and the files it includes, FANOUT
+// of them down to DEPTH levels.
+static const int DEPTH = 6, FANOUT = 3;
+
+static int includeFiles;
+
+static int includeTree(int depth, int n, int scale)
+{
+  string name = depth ? includeName(depth, n) : "incl.x68";
+  FILE *f = create(name.c_str());
+  int lines = 0, i;
+
+  includeFiles++;
+  fprintf(f, "* include tree level %d file %d\n", depth, n);
+  fprintf(f, "K%d_%d\tEQU\t%d\n", depth, n, depth * 100 + n % 100);
+  for (i=0; i<20*scale; i++) {
+    fprintf(f, "I%d_%d_%d\tmove.l\t(a0)+,d%d\n", depth, n, i, i & 7);
+    fprintf(f, "\tadd.w\t#K%d_%d,d%d\n", depth, n, i & 7);
+    fprintf(f, "\tbne.s\tI%d_%d_%d\n", depth, n, i);
+    lines += 3;
+  }
+  if (depth < DEPTH)
+    for (i=0; i<FANOUT; i++) {
+      fprintf(f, "\tINCLUDE\t%s\n", includeName(depth+1, n*FANOUT + i).c_str());
+      lines += includeTree(depth+1, n*FANOUT + i, scale);
+    }
+  // no END, so the starting address is the default one
+  fclose(f);
+  return lines;
+}
+
+//-------------------------------------------------------
+static void macroFile(int scale)
+{
+  FILE *f = create("macro.x68");
+  const int depth = 4;
+  int d;
+
+  fprintf(f, "* %d macro calls %d deep\n", 1000 * scale, depth);
+  // level d calls level d+1 twice, the last level generates code
+  for (d=0; d<depth; d++) {
+    fprintf(f, "LEVEL%d\tMACRO\n", d);
+    if (d == depth-1) {
+      fprintf(f, "L\\@\tmove.\\0\t#\\1,d0\n");
+      fprintf(f, "\tIFARG\t2\n");
+      fprintf(f, "\tadd.\\0\t#\\2,d0\n");
+      fprintf(f, "\tENDC\n");
+      fprintf(f, "\tdbra\td0,L\\@\n");
+    } else {
+      fprintf(f, "\tLEVEL%d.\\0\t\\1+%d,<\\2>\n", d+1, d);
+      fprintf(f, "\tLEVEL%d.\\0\t\\1\n", d+1);
+    }
+    fprintf(f, "\tENDM\n");
+  }
+  for (int i=0; i<1000*scale; i++)
+    fprintf(f, "\tLEVEL0.%c\t%d,%d\n", (i & 1) ? 'L' : 'W', i & 0x7F, (i >> 3) & 0x7);
+  fprintf(f, "\tEND\n");
+  fclose(f);
+  printf("macro.x68   %7d macro calls\n", 1000 * scale * ((1 << depth) - 1));
+}
+
+//-------------------------------------------------------
+static void structFile(int scale)
+{
+  FILE *f = create("struct.x68");
+
+  fprintf(f, "* nested structured code\n");
+  for (int i=0; i<500*scale; i++) {
+    fprintf(f, "\tIF.B\td0 <EQ> #%d THEN\n", i & 0x7F);
+    fprintf(f, "\t  WHILE.W\td1 <LT> #%d DO\n", i & 0xFFF);
+    fprintf(f, "\t    FOR.W\td2 = #1 TO #10 DO\n");
+    fprintf(f, "\t      add.w\td2,d3\n");
+    fprintf(f, "\t    ENDF\n");
+    fprintf(f, "\t    addq.w\t#1,d1\n");
+    fprintf(f, "\t  ENDW\n");
+    fprintf(f, "\tELSE\n");
+    fprintf(f, "\t  REPEAT\n");
+    fprintf(f, "\t    subq.l\t#1,d4\n");
+    fprintf(f, "\t  UNTIL.L\td4 <LE> #0\n");
+    fprintf(f, "\t  DBLOOP\td5 = #%d\n", i & 0xFF);
+    fprintf(f, "\t    move.b\t(a0)+,(a1)+\n");
+    fprintf(f, "\t  UNLESS\n");
+    fprintf(f, "\tENDI\n");
+  }
+  fprintf(f, "\tEND\n");
+  fclose(f);
+  printf("struct.x68  %7d structures\n", 500 * scale * 5);
+}
+
+//-------------------------------------------------------
+static void dataFile(int scale)
+{
+  const int size = 64 * 1024;
+  FILE *f = create("payload.dat");     // not data.bin, the binary output of data.x68
+  int i, bytes = 0;
+
+  for (i=0; i<size; i++)
+    fputc((i * 7 + (i >> 8)) & 0xFF, f);
+  fclose(f);
+
+  f = create("data.x68");
+  fprintf(f, "* INCBIN and DCB data\n");
+  for (i=0; i<4*scale; i++) {
+    fprintf(f, "DATA%d\tINCBIN\t\"payload.dat\"\n", i);
+    fprintf(f, "\tDCB.B\t%d,$%02X\n", 16000 + i, i & 0xFF);
+    fprintf(f, "\tDCB.W\t8000,$%04X\n", i);
+    fprintf(f, "\tDCB.L\t4000,%d\n", i);
+    bytes += size + 16000 + i + 16000 + 16000;
+  }
+  fprintf(f, "\tEND\n");
+  fclose(f);
+  printf("data.x68    %7d bytes of data\n", bytes);
+}
+
+//-------------------------------------------------------
+static void exprFile(int scale)
+{
+  FILE *f = create("expr.x68");
+  int i;
+
+  fprintf(f, "* expression dense tables\n");
+  fprintf(f, "\tORG\t0\n");
+  fprintf(f, "\tINCLUDE\toffsets.x68\n");
+  fprintf(f, "BASE\tEQU\t$8000\n");
+  for (i=0; i<64; i++)
+    fprintf(f, "SYM%d\tEQU\tBASE+%d*%d-(%d<<2)\n", i, i, 6 + (i & 3), i & 7);
+  for (i=0; i<2000*scale; i++) {
+    int a = i & 63, b = (i * 7) & 63, c = (i * 13) & 63;
+    fprintf(f, "TAB%d\tDC.W\tSYM%d+4*%d-(SYM%d>>2),(SYM%d&$FF)!%%1000,~SYM%d&$7FFF\n",
+            i, a, i & 15, b, c, a);
+    fprintf(f, ".T%d\tDC.L\t(.T%d-TAB%d)/2+%d,SYM%d*(2+SYM%d/SYM%d)\n",
+            i & 3, i & 3, i, i, b, c, a | 1);
+    fprintf(f, "\tDC.B\t'A'+%d,SYM%d^SYM%d&$7F,-(%d-SYM%d)>>8\n", i & 15, a, b, i & 0xFF, c);
+  }
+  // labels of an OFFSET block are absolute here, as the code is
+  for (i=0; i<50*scale; i++)
+    fprintf(f, "\tDC.W\tST%d_SIZE,ST%d_F%d*2\n", i, i, i & 7);
+  fprintf(f, "\tEND\n");
+  fclose(f);
+  printf("expr.x68    %7d expressions\n", 2000 * scale * 8);
+
+  f = create("offsets.x68");
+  fprintf(f, "* OFFSET structures for expr.x68\n");
+  for (i=0; i<50*scale; i++) {
+    fprintf(f, "\tOFFSET\t0\n");
+    for (int j=0; j<8; j++)
+      fprintf(f, "ST%d_F%d\tDS.%c\t%d\n", i, j, "BWL"[j % 3], 1 + (i + j) % 4);
+    fprintf(f, "ST%d_SIZE\tDS.B\t0\n", i);
+  }
+  fclose(f);
+}
+
+//-------------------------------------------------------
+static void condFile(int scale)
+{
+  FILE *f = create("cond.x68");
+  int i, j;
+
+  fprintf(f, "* conditional assembly\n");
+  fprintf(f, "DEBUG\tEQU\t0\n");
+  fprintf(f, "MACHINE\tEQU\t2\n");
+  for (i=0; i<1000*scale; i++) {
+    fprintf(f, "\tIFNE\tDEBUG\n");
+    for (j=0; j<8; j++)
+      fprintf(f, "\tmove.l\td%d,-(sp)\t; trace %d\n", j, i);
+    fprintf(f, "\tIFEQ\tMACHINE-1\n");
+    fprintf(f, "\ttrap\t#1\n");
+    fprintf(f, "\tENDC\n");
+    fprintf(f, "\tENDC\n");
+    fprintf(f, "\tIFGE\tMACHINE-%d\n", i & 3);
+    fprintf(f, "\tmoveq\t#%d,d0\n", i & 0x7F);
+    fprintf(f, "\tENDC\n");
+    fprintf(f, "\tIFC\t'%c','A'\n", 'A' + (i & 1));
+    fprintf(f, "\tadd.w\td0,d1\n");
+    fprintf(f, "\tENDC\n");
+  }
+  fprintf(f, "\tEND\n");
+  fclose(f);
+  printf("cond.x68    %7d conditional blocks\n", 1000 * scale * 4);
+}
+
+int main(int argc, char *argv[])
+{
+  int scale;
+
+  dir = (argc > 1) ? argv[1] : ".";
+  scale = (argc > 2) ? atoi(argv[2]) : 1;
+  if (scale < 1)
+    scale = 1;
+
+  mixFile(scale);
+  int lines = includeTree(0, 0, scale);
+  printf("incl.x68    %7d lines in %d files\n", lines, includeFiles);
+  macroFile(scale);
+  structFile(scale);
+  dataFile(scale);
+  exprFile(scale);
+  condFile(scale);
+  return 0;
+}
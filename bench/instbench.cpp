@@ -0,0 +1,163 @@
+/***********************************************************************
+ *
+ *		INSTBENCH.CPP
+ *		Opcode lookup benchmark for 68000 Assembler
+ *
+ *    Times instLookup() (perfect hash of the instruction table plus
+ *    the macro table) against the binary search of instTable[] with
+ *    macros looked up in the symbol table, which is how opcodes were
+ *    found before. The lines are a mix of instructions with and
+ *    without size codes, directives and macro calls, looked up with
+ *    a few thousand labels in the symbol table.
+ *
+ *	 Usage: instbench [passes]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <chrono>
+#include "../asm.h"
+
+extern instruction instTable[];
+extern int tableSize;
+extern instruction asmMac;
+extern thread_local int macroIndex;
+extern thread_local bool BITflag;
+extern thread_local bool pass2;
+
+//-------------------------------------------------------
+// Binary search version of instLookup()
+static char *searchLookup(char *p, instruction *(*instPtrPtr), char *sizePtr, int *errorPtr)
+{
+  char opcode[SIGCHARS+1];
+  int i, hi, lo, mid, cmp;
+  symbolDef *symbol;
+
+  i = 0;
+  do {
+    if (i < SIGCHARS)
+      opcode[i++] = *p;
+    p++;
+  } while (isalnum(*p) || *p == '_' || *p == '-');
+  opcode[i] = '\0';
+  if (*p == '.')
+    if (isspace((unsigned char)p[2]) || !p[2]) {
+      if (p[1] == 'B')
+        *sizePtr = BYTE_SIZE;
+      else if (p[1] == 'W' || isspace((unsigned char)p[1]))
+        *sizePtr = WORD_SIZE;
+      else if (p[1] == 'L')
+        *sizePtr = LONG_SIZE;
+      else if (p[1] == 'S')
+        *sizePtr = SHORT_SIZE;
+      else {
+        *sizePtr = 0;
+        NEWERROR(*errorPtr, INV_SIZE_CODE);
+      }
+      p += 2;
+    } else {
+      NEWERROR(*errorPtr, SYNTAX);
+      return NULL;
+    }
+  else if (!isspace((unsigned char)*p) && *p) {
+    NEWERROR(*errorPtr, SYNTAX);
+    return NULL;
+  }
+  else
+    *sizePtr = 0;
+
+  lo = 0;
+  hi = tableSize - 1;
+  do {
+    mid = (hi + lo) / 2;
+    cmp = strcmp(opcode, instTable[mid].mnemonic);
+    if (cmp > 0)
+      lo = mid + 1;
+    else if (cmp < 0)
+      hi = mid - 1;
+  } while (cmp && (hi >= lo));
+
+  if (!cmp) {
+    if (instTable[mid].flavorPtr &&
+        instTable[mid].flavorPtr->exec == bitField && !BITflag) {
+      NEWERROR(*errorPtr, INV_OPCODE);
+      return NULL;
+    }
+    *instPtrPtr = &instTable[mid];
+    return p;
+  }
+  symbol = lookup(opcode, false, errorPtr);
+  if ((*errorPtr < ERRORN) && (symbol->flags & MACRO_SYM)) {
+    *instPtrPtr = &asmMac;
+    macroIndex = symbol->value.value;
+    return p;
+  }
+  NEWERROR(*errorPtr, INV_OPCODE);
+  return NULL;
+}
+
+static const char *lines[] = {
+  "MOVE.L D0,D1", "MOVE.W (A0)+,D2", "MOVEQ #0,D0", "LEA 4(A0),A1",
+  "ADD.L D1,D2", "SUBQ.W #1,D7", "CMP.B #$20,D0", "BEQ.S LOOP",
+  "BNE LABEL1", "BRA.S NEXT", "JSR PRINT", "RTS", "DBRA D7,LOOP",
+  "TST.L D0", "CLR.W D1", "AND.B #$DF,D0", "LSL.L #2,D0", "SWAP D0",
+  "MOVEM.L D0-D7/A0-A6,-(A7)", "TRAP #1", "DC.W 0", "DC.L LABEL1",
+  "DS.B 16", "EQU 5", "IF D0 <EQ> #0 THEN", "ENDI", "PRINTIT D0",
+  "SAVEREGS", "BTST #0,D0", "EXT.L D0", "NOP", "MULU D1,D2",
+};
+
+int main(int argc, char *argv[])
+{
+  int passes = (argc > 1) ? atoi(argv[1]) : 200000;
+  const int count = sizeof(lines) / sizeof(lines[0]);
+  char name[SIGCHARS+1], text[count][80];
+  instruction *inst;
+  char size;
+  int error;
+  exprVal value;
+  symbolDef *symbol;
+
+  // a symbol table the size of a medium program, and two macros
+  value.isRelative = true;
+  for (int i=0; i<5000; i++) {
+    sprintf(name, "LABEL%d", i);
+    value.value = i * 2;
+    error = OK;
+    define(name, value, false, true, &error);
+  }
+  const char *macros[] = { "PRINTIT", "SAVEREGS" };
+  for (int i=0; i<2; i++) {
+    strcpy(name, macros[i]);
+    value.value = i;
+    error = OK;
+    symbol = define(name, value, false, true, &error);
+    symbol->flags |= MACRO_SYM;
+    addMacro(symbol);
+  }
+
+  for (int i=0; i<count; i++)
+    strcpy(text[i], lines[i]);
+
+  for (int method=0; method<2; method++) {
+    unsigned int found = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int n=0; n<passes; n++)
+      for (int i=0; i<count; i++) {
+        error = OK;
+        if (method == 0)
+          found += (searchLookup(text[i], &inst, &size, &error) != NULL);
+        else
+          found += (instLookup(text[i], &inst, &size, &error) != NULL);
+      }
+    auto end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    double lines = (double)passes * count;
+    printf("%-14s %12.0f lines/s  %8.1f ns/line  (%u found)\n",
+           method == 0 ? "binary search" : "perfect hash",
+           lines / sec, sec * 1e9 / lines, found);
+  }
+  clearSymbols();
+  return 0;
+}
@@ -0,0 +1,84 @@
+/***********************************************************************
+ *
+ *		MACROBENCH.CPP
+ *		Macro expansion benchmark for 68000 Assembler
+ *
+ *    Writes a source file in which a few thousand calls each expand
+ *    a chain of macros nested DEPTH deep (with arguments, \@ labels
+ *    and IFARG), assembles it with listing and object output turned
+ *    off and prints the time per pass and the number of expanded
+ *    lines per second.
+ *
+ *	 Usage: macrobench [calls [depth [runs]]]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "../asm.h"
+
+extern thread_local bool listFlag, objFlag, binFlag, CREflag, WARflag;
+extern thread_local int errorCount;
+
+int main(int argc, char *argv[])
+{
+  int calls = (argc > 1) ? atoi(argv[1]) : 2000;
+  int depth = (argc > 2) ? atoi(argv[2]) : 8;
+  int runs  = (argc > 3) ? atoi(argv[3]) : 5;
+  char name[] = "macrobench.x68";
+  FILE *f;
+  int d;
+
+  if (depth < 1 || depth > MACRO_NEST_LIMIT)
+    depth = 8;
+
+  f = fopen(name, "w");
+  if (!f) {
+    fprintf(stderr, "Can't create %s\n", name);
+    return 1;
+  }
+  fprintf(f, "\tORG\t$1000\n");
+  // level d calls level d+1 twice, the last level generates code
+  for (d=0; d<depth; d++) {
+    fprintf(f, "LEVEL%d\tMACRO\n", d);
+    fprintf(f, "* level %d of %d, argument \\1\n", d, depth);
+    if (d == depth-1) {
+      fprintf(f, "L\\@\tmove.\\0\t#\\1,d0\n");
+      fprintf(f, "\tIFARG\t2\n");
+      fprintf(f, "\tadd.\\0\t#\\2,d0\n");
+      fprintf(f, "\tENDC\n");
+      fprintf(f, "\tdbra\td0,L\\@\n");
+    } else {
+      fprintf(f, "\tLEVEL%d.\\0\t\\1+%d,<\\2>\n", d+1, d);
+      fprintf(f, "\tLEVEL%d\t\\1\n", d+1);
+    }
+    fprintf(f, "\tENDM\n");
+  }
+  for (int i=0; i<calls; i++)
+    fprintf(f, "\tLEVEL0.%c\t%d,%d\n", (i & 1) ? 'L' : 'W', i & 0xFF, (i >> 3) & 0x7);
+  fprintf(f, "\tEND\t$1000\n");
+  fclose(f);
+
+  listFlag = false;
+  objFlag = false;
+  binFlag = false;
+  CREflag = false;
+  WARflag = false;
+
+  // every call expands 2^depth - 1 macros
+  double lines = (double)calls * ((1 << depth) - 1) * 4 * 2;
+  double best = 0;
+  for (int r=0; r<runs; r++) {
+    auto start = std::chrono::steady_clock::now();
+    assembleFile(name, name);
+    auto end = std::chrono::steady_clock::now();
+    double sec = std::chrono::duration<double>(end - start).count();
+    if (r == 0 || sec < best)
+      best = sec;
+  }
+  printf("%d calls, depth %d: %.3f s  %.0f macro lines/s  (%d errors)\n",
+         calls, depth, best, lines / best, errorCount);
+  remove(name);
+  return 0;
+}
@@ -0,0 +1,378 @@
+/***********************************************************************
+ *
+ *		RUNBENCH.CPP
+ *		Benchmark harness for the 68000 Assembler
+ *
+ *    Runs asy68k with --times on each source written by gensrc,
+ *    first with the listing, S-record and binary outputs switched on
+ *    and off, then with each assembly engine (two passes, single
+ *    pass, branch relaxation) and all outputs on. Each case is run a
+ *    few times and the fastest run is kept.
+ *
+ *    One CSV line is written per case with the wall time, the time of
+ *    each phase from --times, lines per second, the peak resident set
+ *    size of the assembler and the size of each output file, so
+ *    results can be compared between builds. A summary is printed as
+ *    well.
+ *
+ *    Last each source is assembled by asy68k itself and then through
+ *    an asy68k --serve server, one request after another, and the
+ *    output files must be the same. So must those of expr.x68 when
+ *    the offsets.x68 it includes is precompiled, and those of each
+ *    source with the single pass and the two pass engine, as
+ *    asy68k --compare-engines compares them.
+ *
+ *	 Usage: runbench asy68k directory results.csv [runs]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <signal.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <chrono>
+#include <string>
+
+using std::string;
+
+static const char *sources[] = { "mix", "incl", "macro", "struct", "data", "expr", "cond" };
+
+struct benchCase {
+  const char *engine;           // name in the results
+  const char *outputs;
+  const char *options[4];       // asy68k options, NULL terminated
+};
+
+static const benchCase cases[] = {
+  { "twopass", "list+srec+bin", { NULL } },
+  { "twopass", "srec+bin",      { "--no-list", NULL } },
+  { "twopass", "bin",           { "--no-list", "--no-object", NULL } },
+  { "twopass", "list",          { "--no-object", "--no-binary", NULL } },
+  { "twopass", "none",          { "--no-list", "--no-object", "--no-binary", NULL } },
+  { "single",  "list+srec+bin", { "--single-pass", NULL } },
+  { "relax",   "list+srec+bin", { "--relax", NULL } },
+};
+
+struct benchResult {
+  double wall;                  // ms
+  double phase[4];              // load, pass 1, pass 2, output in ms
+  int lines;
+  long rss;                     // peak resident set size in KB
+  long size[3];                 // .L68, .S68, .bin in bytes
+};
+
+//-------------------------------------------------------
+static long fileSize(const string &name)
+{
+  struct stat st;
+
+  return stat(name.c_str(), &st) ? 0 : (long)st.st_size;
+}
+
+//-------------------------------------------------------
+// Run asy68k once on dir/name.x68, returns false if it could not run
+static bool runOnce(const char *asy68k, const string &dir, const char *name,
+                    const benchCase &c, benchResult &r)
+{
+  static const char *exts[] = { ".L68", ".S68", ".bin" };
+  string base = dir + "/" + name;
+  string source = base + ".x68";
+  const char *argv[9];
+  char text[4096];
+  int fd[2], status, n, i, argc = 0;
+  size_t used = 0;
+  struct rusage usage;
+  pid_t pid;
+
+  for (i=0; i<3; i++)
+    remove((base + exts[i]).c_str());
+
+  argv[argc++] = asy68k;
+  argv[argc++] = "--times";
+  for (i=0; c.options[i]; i++)
+    argv[argc++] = c.options[i];
+  argv[argc++] = source.c_str();
+  argv[argc] = NULL;
+
+  if (pipe(fd))
+    return false;
+  auto start = std::chrono::steady_clock::now();
+  pid = fork();
+  if (pid < 0)
+    return false;
+  if (pid == 0) {               // asy68k prints its messages to stderr
+    dup2(fd[1], 2);
+    close(fd[0]);
+    close(fd[1]);
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    execv(asy68k, (char **)argv);
+    _exit(127);
+  }
+  close(fd[1]);
+  while ((n = read(fd[0], text + used, sizeof(text) - 1 - used)) > 0)
+    used += n;
+  text[used] = '\0';
+  close(fd[0]);
+  if (wait4(pid, &status, 0, &usage) < 0)
+    return false;
+  auto end = std::chrono::steady_clock::now();
+  if (!WIFEXITED(status) || WEXITSTATUS(status) == 127)
+    return false;
+
+  r.wall = std::chrono::duration<double, std::milli>(end - start).count();
+  r.rss = usage.ru_maxrss;
+  r.lines = 0;
+  for (i=0; i<4; i++)
+    r.phase[i] = 0;
+  const char *t = strstr(text, "Times:");
+  if (t)
+    sscanf(t, "Times: load %lf ms, pass 1 %lf ms, pass 2 %lf ms, output %lf ms, %d lines",
+           &r.phase[0], &r.phase[1], &r.phase[2], &r.phase[3], &r.lines);
+  for (i=0; i<3; i++)
+    r.size[i] = fileSize(base + exts[i]);
+  return true;
+}
+
+//-------------------------------------------------------
+// Run asy68k with its messages thrown away, returns its exit status
+static int runQuiet(const char *asy68k, const char *option, const string &source)
+{
+  const char *argv[4];
+  int status, argc = 0;
+  pid_t pid;
+
+  argv[argc++] = asy68k;
+  if (option)
+    argv[argc++] = option;
+  argv[argc++] = source.c_str();
+  argv[argc] = NULL;
+  pid = fork();
+  if (pid < 0)
+    return -1;
+  if (pid == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    dup2(null, 2);
+    execv(asy68k, (char **)argv);
+    _exit(127);
+  }
+  if (waitpid(pid, &status, 0) < 0 || !WIFEXITED(status))
+    return -1;
+  return WEXITSTATUS(status);
+}
+
+//-------------------------------------------------------
+// The output files of dir/name.x68 one after another. The listing
+// starts after its header, which has the time it was made. Without
+// listing only its error and warning counts are kept.
+static string outputs(const string &base, bool listing)
+{
+  static const char *exts[] = { ".L68", ".S68", ".bin" };
+  string all;
+  char text[4096];
+  size_t n;
+
+  for (int i=0; i<3; i++) {
+    FILE *f = fopen((base + exts[i]).c_str(), "rb");
+    all += exts[i];
+    if (!f)
+      continue;
+    if (i == 0)
+      for (int line=0; line<3 && fgets(text, sizeof(text), f); line++)
+        ;
+    if (i == 0 && !listing) {
+      while (fgets(text, sizeof(text), f))
+        if (strstr(text, " detected") || strstr(text, " generated"))
+          all += text;
+    }
+    else
+      while ((n = fread(text, 1, sizeof(text), f)) > 0)
+        all.append(text, n);
+    fclose(f);
+  }
+  return all;
+}
+
+//-------------------------------------------------------
+// Assemble each source directly and through a server, returns the
+// number of sources whose outputs differ or -1 if the server did not
+// start. Every source goes to the same server, so state one request
+// leaves behind shows up in the next.
+static int serveCheck(const char *asy68k, const string &dir, int sourceCount)
+{
+  string sock = dir + "/runbench.sock";
+  string serveOption = "--serve=" + sock;
+  string clientOption = "--client=" + sock;
+  struct stat st;
+  int s, i, status, failed = 0;
+  pid_t server;
+
+  remove(sock.c_str());
+  server = fork();
+  if (server < 0)
+    return -1;
+  if (server == 0) {
+    int null = open("/dev/null", O_WRONLY);
+    dup2(null, 1);
+    dup2(null, 2);
+    execl(asy68k, asy68k, serveOption.c_str(), (char *)NULL);
+    _exit(127);
+  }
+  for (i=0; i<100 && stat(sock.c_str(), &st) != 0; i++)
+    usleep(20000);
+  if (i == 100) {
+    kill(server, SIGTERM);
+    waitpid(server, &status, 0);
+    return -1;
+  }
+
+  for (s=0; s<sourceCount; s++) {
+    string base = dir + "/" + sources[s];
+    int direct = runQuiet(asy68k, NULL, base + ".x68");
+    string expected = outputs(base, true);
+    // twice, the second request uses what the first one kept
+    int served = runQuiet(asy68k, clientOption.c_str(), base + ".x68");
+    bool same = direct == served && outputs(base, true) == expected;
+    served = runQuiet(asy68k, clientOption.c_str(), base + ".x68");
+    same = same && direct == served && outputs(base, true) == expected;
+    printf("%-8s %s\n", sources[s], same ? "same" : "DIFFERENT");
+    if (!same)
+      failed++;
+  }
+
+  kill(server, SIGTERM);
+  waitpid(server, &status, 0);
+  remove(sock.c_str());
+  return failed;
+}
+
+//-------------------------------------------------------
+// Assemble expr.x68 with offsets.x68 as source and as a precompiled
+// include, returns 1 if the outputs differ or -1 if it can't be
+// precompiled. The listings differ, as the snapshot is listed as one
+// line.
+static int precompCheck(const char *asy68k, const string &dir)
+{
+  string base = dir + "/expr";
+  string lib = dir + "/offsets";
+  struct stat st;
+  int direct, loaded;
+
+  remove((lib + ".P68").c_str());
+  direct = runQuiet(asy68k, NULL, base + ".x68");
+  string expected = outputs(base, false);
+  runQuiet(asy68k, "--precompile", lib + ".x68");
+  if (stat((lib + ".P68").c_str(), &st) != 0)
+    return -1;
+  loaded = runQuiet(asy68k, NULL, base + ".x68");
+  bool same = direct == loaded && outputs(base, false) == expected;
+  printf("%-8s %s\n", "expr", same ? "same" : "DIFFERENT");
+  remove((lib + ".P68").c_str());
+  remove((lib + ".L68").c_str());
+  return same ? 0 : 1;
+}
+
+//-------------------------------------------------------
+// Assemble each source with --compare-engines, returns the number of
+// sources whose single pass output differs from the two pass output.
+// The single pass files are only left behind when they differ.
+static int enginesCheck(const char *asy68k, const string &dir, int sourceCount)
+{
+  static const char *exts[] = { ".L68", ".S68", ".bin" };
+  struct stat st;
+  int s, i, failed = 0;
+
+  for (s=0; s<sourceCount; s++) {
+    string base = dir + "/" + sources[s];
+    string work = base + "_1pass";
+    bool same = true;
+    for (i=0; i<3; i++)
+      remove((work + exts[i]).c_str());
+    runQuiet(asy68k, "--compare-engines", base + ".x68");
+    for (i=0; i<3; i++)
+      if (stat((work + exts[i]).c_str(), &st) == 0)
+        same = false;
+    printf("%-8s %s\n", sources[s], same ? "same" : "DIFFERENT");
+    if (!same)
+      failed++;
+  }
+  return failed;
+}
+
+int main(int argc, char *argv[])
+{
+  const int sourceCount = sizeof(sources) / sizeof(sources[0]);
+  const int caseCount = sizeof(cases) / sizeof(cases[0]);
+  FILE *csv;
+  int runs, s, c, n;
+
+  if (argc < 4) {
+    fprintf(stderr, "Usage: runbench asy68k directory results.csv [runs]\n");
+    return 1;
+  }
+  runs = (argc > 4) ? atoi(argv[4]) : 3;
+  if (runs < 1)
+    runs = 1;
+
+  csv = fopen(argv[3], "w");
+  if (!csv) {
+    fprintf(stderr, "Can't create %s\n", argv[3]);
+    return 1;
+  }
+  fprintf(csv, "source,engine,outputs,wall_ms,load_ms,pass1_ms,pass2_ms,output_ms,"
+               "lines,lines_per_s,peak_rss_kb,list_bytes,srec_bytes,bin_bytes\n");
+  printf("%-8s %-8s %-14s %9s %9s %9s %12s %9s\n", "source", "engine", "outputs",
+         "wall ms", "pass1 ms", "pass2 ms", "lines/s", "RSS KB");
+
+  for (s=0; s<sourceCount; s++)
+    for (c=0; c<caseCount; c++) {
+      benchResult best, r;
+      long rss = 0;
+      for (n=0; n<runs; n++) {
+        if (!runOnce(argv[1], argv[2], sources[s], cases[c], r)) {
+          fprintf(stderr, "Can't run %s on %s/%s.x68\n", argv[1], argv[2], sources[s]);
+          return 1;
+        }
+        if (n == 0 || r.wall < best.wall)
+          best = r;
+        if (r.rss > rss)
+          rss = r.rss;
+      }
+      double rate = best.wall > 0 ? best.lines * 1000.0 / best.wall : 0;
+      fprintf(csv, "%s,%s,%s,%.2f,%.2f,%.2f,%.2f,%.2f,%d,%.0f,%ld,%ld,%ld,%ld\n",
+              sources[s], cases[c].engine, cases[c].outputs, best.wall,
+              best.phase[0], best.phase[1], best.phase[2], best.phase[3],
+              best.lines, rate, rss, best.size[0], best.size[1], best.size[2]);
+      printf("%-8s %-8s %-14s %9.1f %9.1f %9.1f %12.0f %9ld\n", sources[s],
+             cases[c].engine, cases[c].outputs, best.wall, best.phase[1],
+             best.phase[2], rate, rss);
+    }
+  fclose(csv);
+  printf("\nResults written to %s\n", argv[3]);
+
+  printf("\nServer against asy68k\n");
+  n = serveCheck(argv[1], argv[2], sourceCount);
+  if (n < 0)
+    fprintf(stderr, "Can't start %s --serve\n", argv[1]);
+  else if (n > 0)
+    fprintf(stderr, "%d source%s assembled differently by the server\n", n, n == 1 ? "" : "s");
+
+  printf("\nPrecompiled include against source\n");
+  c = precompCheck(argv[1], argv[2]);
+  if (c < 0)
+    fprintf(stderr, "Can't precompile %s/offsets.x68\n", argv[2]);
+  else if (c > 0)
+    fprintf(stderr, "expr.x68 assembled differently with offsets.P68\n");
+
+  printf("\nSingle pass against two passes\n");
+  int e = enginesCheck(argv[1], argv[2], sourceCount);
+  if (e > 0)
+    fprintf(stderr, "%d source%s assembled differently in a single pass\n", e, e == 1 ? "" : "s");
+  return n != 0 || c != 0 || e != 0;
+}
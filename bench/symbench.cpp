@@ -0,0 +1,68 @@
+/***********************************************************************
+ *
+ *		SYMBENCH.CPP
+ *		Symbol table benchmark for 68000 Assembler
+ *
+ *    Defines an increasing number of symbols with the kinds of names
+ *    found in real sources (plain labels, structured code labels
+ *    _00000123 and local labels GLOBAL:LOCAL) and measures the average
+ *    time of lookup() for each table size. With a working hash table
+ *    the time per lookup stays flat as the symbol count grows.
+ *
+ *	 Usage: symbench [lookups]
+ *
+ ************************************************************************/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "../asm.h"
+
+// build the name of symbol n
+static void symbolName(int n, char *name)
+{
+  switch (n % 3) {
+    case 0: sprintf(name, "LABEL%d", n); break;
+    case 1: sprintf(name, "_%08X", n); break;
+    default: sprintf(name, "GLOBAL%d:L%d", n / 100, n % 100); break;
+  }
+}
+
+int main(int argc, char *argv[])
+{
+  int lookups = (argc > 1) ? atoi(argv[1]) : 2000000;
+  int sizes[] = { 1000, 4000, 16000, 64000, 256000 };
+  char name[SIGCHARS+1];
+  exprVal value;
+
+  printf("%10s %12s %12s\n", "symbols", "lookups", "ns/lookup");
+  for (unsigned int s=0; s<sizeof(sizes)/sizeof(sizes[0]); s++) {
+    int count = sizes[s];
+    int error = OK;
+
+    clearSymbols();
+    value.isRelative = true;
+    for (int i=0; i<count; i++) {
+      symbolName(i, name);
+      value.value = i * 2;
+      define(name, value, false, true, &error);
+    }
+
+    // look up existing symbols in a scattered order
+    unsigned int seed = 12345, sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int i=0; i<lookups; i++) {
+      seed = seed * 1103515245 + 12345;
+      symbolName((seed >> 8) % count, name);
+      error = OK;
+      symbolDef *sym = lookup(name, false, &error);
+      if (sym)
+        sum += sym->value.value;
+    }
+    auto end = std::chrono::steady_clock::now();
+    double ns = std::chrono::duration<double, std::nano>(end - start).count();
+    printf("%10d %12d %12.1f   (%u)\n", count, lookups, ns / lookups, sum & 0xF);
+  }
+  clearSymbols();
+  return 0;
+}
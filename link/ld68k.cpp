@@ -0,0 +1,395 @@
+/***********************************************************************
+ *
+ *		LD68K.CPP
+ *		Linker for Relocatable Objects of the 68000 Assembler
+ *
+ *		Combines the relocatable objects (.R68) written by
+ *		asy68k --relocatable into a QL executable, so only the
+ *		modules that changed need to be assembled again.
+ *
+ *		Section 0 of every module comes first, in the order
+ *		the objects are given, then section 1 and so on. Each
+ *		XREF symbol is matched with the XDEF symbol of the same
+ *		name, and each relocation gets the displacement from
+ *		its field to its target, or the value of an imported
+ *		constant. An import no field uses may be left
+ *		undefined. The executable gets the QDOS
+ *		header with the largest data space asked for by a SIZE
+ *		directive in any module, or 500 bytes if there is none,
+ *		the same as the assembler gives a single file.
+ *
+ *	 Usage:	ld68k {options} file1.R68 {file2.R68} ...
+ *
+ *		-o file   name of the executable (default: first
+ *		          object with .bin)
+ *		-s size   data space in the QDOS header
+ *		-m        print a map of the sections and symbols
+ *		-S file   also write the executable as S-records
+ *		          loaded at address 0, with SREC.CPP
+ *
+ ************************************************************************/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "../reloc.h"
+#include "../srec.h"
+
+using std::string;
+
+#define DEFAULT_DATA_SIZE 500   // as initBin() in BINFILE.CPP
+
+struct objSection {
+  int size;
+  const unsigned char *code;
+  int addr;                     // address in the executable
+};
+
+struct objSymbol {
+  string name;
+  int section;                  // section, or RELOC_ABSOLUTE
+  int value;
+};
+
+struct objReloc {
+  int section, offset, type, target;
+};
+
+struct objModule {
+  string name;
+  std::vector<unsigned char> file;
+  int dataSize;                 // -1 if no SIZE directive
+  objSection sections[RELOC_SECTIONS];
+  std::vector<objSymbol> exports;
+  std::vector<string> imports;
+  std::vector<objReloc> relocs;
+};
+
+struct linkSymbol {
+  int module;                   // module that exports it
+  int address;                  // address in the executable, or value
+  bool isAddress;               // false for a constant
+};
+
+static std::vector<objModule> modules;
+static std::unordered_map<string, linkSymbol> symbols;
+static int errors;
+
+//------------------------------------------------------
+static void linkError(const char *module, const char *message, const char *name)
+{
+  fprintf(stderr, "ERROR: %s: %s%s%s\n", module, message,
+          name ? " " : "", name ? name : "");
+  errors++;
+}
+
+//------------------------------------------------------
+// Reads the object file, returns false if it is not one
+static bool readObject(objModule &m)
+{
+  FILE *f;
+  long size;
+  size_t pos = 0;
+  int i, n, count;
+
+  f = fopen(m.name.c_str(), "rb");
+  if (!f) {
+    linkError(m.name.c_str(), "can't open the file", NULL);
+    return false;
+  }
+  fseek(f, 0, SEEK_END);
+  size = ftell(f);
+  rewind(f);
+  m.file.resize(size > 0 ? size : 0);
+  if (size > 0 && fread(&m.file[0], 1, size, f) != (size_t)size)
+    size = 0;
+  fclose(f);
+
+  const unsigned char *p = m.file.empty() ? NULL : &m.file[0];
+  bool ok = true;
+  // each read checks that the bytes are there first
+  auto need = [&](size_t count) {
+    if (pos + count > m.file.size())
+      ok = false;
+    return ok;
+  };
+  auto word = [&]() {
+    if (!need(2)) return 0;
+    pos += 2;
+    return (p[pos-2] << 8) | p[pos-1];
+  };
+  auto longWord = [&]() {
+    if (!need(4)) return 0;
+    pos += 4;
+    return (int)(((unsigned)p[pos-4] << 24) | (p[pos-3] << 16) | (p[pos-2] << 8) | p[pos-1]);
+  };
+  auto name = [&]() {
+    string s;
+    if (need(1) && need(1 + p[pos])) {
+      s.assign((const char *)p + pos + 1, p[pos]);
+      pos += 1 + p[pos];
+    }
+    return s;
+  };
+
+  if (!need(4) || memcmp(p, RELOC_MAGIC, 4)) {
+    linkError(m.name.c_str(), "not a relocatable object", NULL);
+    return false;
+  }
+  pos = 4;
+  m.dataSize = longWord();
+  for (i=0; i<RELOC_SECTIONS; i++) {
+    m.sections[i].size = 0;
+    m.sections[i].code = NULL;
+  }
+  count = word();
+  for (i=0; i<count && ok; i++) {
+    n = word();
+    int bytes = longWord();
+    if (n >= RELOC_SECTIONS || bytes < 0 || !need(bytes)) {
+      ok = false;
+      break;
+    }
+    m.sections[n].size = bytes;
+    m.sections[n].code = p + pos;
+    pos += bytes;
+  }
+  count = word();
+  for (i=0; i<count && ok; i++) {
+    objSymbol s;
+    s.name = name();
+    s.section = word();
+    s.value = longWord();
+    m.exports.push_back(s);
+  }
+  count = word();
+  for (i=0; i<count && ok; i++)
+    m.imports.push_back(name());
+  count = longWord();
+  for (i=0; i<count && ok; i++) {
+    objReloc r;
+    r.section = word();
+    r.offset = longWord();
+    r.type = word();
+    r.target = word();
+    m.relocs.push_back(r);
+  }
+  if (!ok)
+    linkError(m.name.c_str(), "object file is damaged", NULL);
+  return ok;
+}
+
+//------------------------------------------------------
+static void usage()
+{
+  fprintf(stderr, "Usage:\n   ld68k {options} file1.R68 {file2.R68} ...\n\n"
+                  "-o file              name of the QL executable (default: first object\n"
+                  "                     with .bin)\n"
+                  "-s size              data space in the QDOS header (default: largest\n"
+                  "                     SIZE directive, or 500)\n"
+                  "-m                   print a map of the sections and symbols\n"
+                  "-S file              also write the code to file as S-records,\n"
+                  "                     loaded at address 0\n"
+                  "\n");
+}
+
+int main(int argc, char *argv[])
+{
+  string outName, srecName;
+  int dataSize = -1;
+  bool map = false;
+  int i, s, addr;
+  size_t m, n;
+
+  for (i=1; i<argc; i++) {
+    if (!strcmp(argv[i], "-o") && i+1 < argc)   {outName = argv[++i]; continue;}
+    if (!strcmp(argv[i], "-s") && i+1 < argc)   {dataSize = atoi(argv[++i]); continue;}
+    if (!strcmp(argv[i], "-m"))                 {map = true; continue;}
+    if (!strcmp(argv[i], "-S") && i+1 < argc)   {srecName = argv[++i]; continue;}
+    if (argv[i][0] == '-') {usage(); fprintf(stderr, "\n\nUnknown option \"%s\"\n", argv[i]); exit(1);}
+    objModule mod;
+    mod.name = argv[i];
+    modules.push_back(mod);
+  }
+  if (modules.empty()) {usage(); exit(1);}
+  if (outName.empty()) {
+    outName = modules[0].name;
+    string::size_type dot = outName.rfind('.');
+    if (dot != string::npos && outName.find_first_of("/\\", dot) == string::npos)
+      outName.erase(dot);
+    outName += ".bin";
+  }
+
+  for (m=0; m<modules.size(); m++)
+    if (!readObject(modules[m]))
+      exit(1);
+
+  // place the sections
+  addr = 0;
+  for (s=0; s<RELOC_SECTIONS; s++)
+    for (m=0; m<modules.size(); m++) {
+      modules[m].sections[s].addr = addr;
+      addr += (modules[m].sections[s].size + 1) & ~1;
+    }
+  std::vector<unsigned char> image(addr, 0);
+  for (s=0; s<RELOC_SECTIONS; s++)
+    for (m=0; m<modules.size(); m++)
+      if (modules[m].sections[s].size)
+        memcpy(&image[modules[m].sections[s].addr], modules[m].sections[s].code,
+               modules[m].sections[s].size);
+
+  // collect the exported symbols
+  for (m=0; m<modules.size(); m++)
+    for (n=0; n<modules[m].exports.size(); n++) {
+      objSymbol &e = modules[m].exports[n];
+      linkSymbol l;
+      l.module = m;
+      l.isAddress = (e.section != RELOC_ABSOLUTE);
+      if (l.isAddress && e.section >= RELOC_SECTIONS) {
+        linkError(modules[m].name.c_str(), "bad section for", e.name.c_str());
+        continue;
+      }
+      l.address = l.isAddress ? modules[m].sections[e.section].addr + e.value : e.value;
+      if (!symbols.insert(std::make_pair(e.name, l)).second) {
+        string message = "symbol also defined in " + modules[symbols[e.name].module].name + ":";
+        linkError(modules[m].name.c_str(), message.c_str(), e.name.c_str());
+      }
+    }
+
+  // fix up the fields that refer to other sections and modules, an
+  // import is only reported if a field uses it
+  for (m=0; m<modules.size(); m++) {
+    objModule &mod = modules[m];
+    std::vector<const linkSymbol *> import(mod.imports.size(), NULL);
+    std::vector<bool> reported(mod.imports.size(), false);
+    for (n=0; n<mod.imports.size(); n++) {
+      auto it = symbols.find(mod.imports[n]);
+      if (it != symbols.end())
+        import[n] = &it->second;
+    }
+    for (n=0; n<mod.relocs.size(); n++) {
+      objReloc &r = mod.relocs[n];
+      int target, field, value;
+      bool pc = (r.type == RELOC_PC16);
+      int bytes = (r.type == RELOC_ABS32) ? 4 : 2;
+      if ((!pc && r.type != RELOC_ABS16 && r.type != RELOC_ABS32)
+          || r.section >= RELOC_SECTIONS
+          || r.offset < 0 || r.offset + bytes > mod.sections[r.section].size) {
+        linkError(mod.name.c_str(), "bad relocation", NULL);
+        continue;
+      }
+      if (pc && r.target < RELOC_SECTIONS)
+        target = mod.sections[r.target].addr;
+      else if (r.target >= RELOC_IMPORT && (size_t)(r.target - RELOC_IMPORT) < mod.imports.size()) {
+        i = r.target - RELOC_IMPORT;
+        // a PC relative field needs an address, any other a constant
+        const char *message = !import[i] ? "undefined symbol"
+                            : import[i]->isAddress == pc ? NULL
+                            : pc ? "constant used as an address:"
+                            : "address used as a constant:";
+        if (message) {
+          if (!reported[i])
+            linkError(mod.name.c_str(), message, mod.imports[i].c_str());
+          reported[i] = true;
+          continue;
+        }
+        target = import[i]->address;
+      } else {
+        linkError(mod.name.c_str(), "bad relocation", NULL);
+        continue;
+      }
+      field = mod.sections[r.section].addr + r.offset;
+      if (r.type == RELOC_ABS32) {
+        value = (int)(((unsigned)image[field] << 24) | (image[field+1] << 16)
+                      | (image[field+2] << 8) | image[field+3]) + target;
+        image[field] = value >> 24;
+        image[field+1] = value >> 16;
+        image[field+2] = value >> 8;
+        image[field+3] = value;
+        continue;
+      }
+      value = (short)((image[field] << 8) | image[field+1]) + target;
+      if (pc)
+        value -= field;
+      if (value < -32768 || value > (pc ? 32767 : 65535)) {
+        char where[64];
+        sprintf(where, "section %d offset $%X", r.section, r.offset);
+        linkError(mod.name.c_str(), pc ? "displacement out of range at"
+                                       : "value out of range at", where);
+      }
+      image[field] = value >> 8;
+      image[field+1] = value;
+    }
+  }
+  if (errors)
+    exit(1);
+
+  if (dataSize < 0)
+    for (m=0; m<modules.size(); m++)
+      if (modules[m].dataSize > dataSize)
+        dataSize = modules[m].dataSize;
+  if (dataSize < 0)
+    dataSize = DEFAULT_DATA_SIZE;
+
+  // write the QDOS header, as finishBin() does, then the code
+  FILE *f = fopen(outName.c_str(), "wb");
+  if (!f) {
+    linkError(outName.c_str(), "can't create the file", NULL);
+    exit(1);
+  }
+  if (!image.empty() && dataSize) {
+    static const char *headString = "]!QDOS File Header";
+    unsigned char head[30] = { 0 };
+    strcpy((char*)head, headString);
+    head[19] = 15;  // Header size in words
+    head[21] = 1;   // QDOS executable flag
+    for (i=0; i<4; i++)
+      head[22+i] = dataSize >> 8*(3-i);
+    fwrite(head, 1, sizeof(head), f);
+  }
+  if (!image.empty())
+    fwrite(&image[0], 1, image.size(), f);
+  fclose(f);
+
+  // the same image as S-records, as finishObj() writes them
+  if (!srecName.empty()) {
+    string text;
+    srecRange range;
+    range.addr = 0;
+    range.offset = 0;
+    range.length = image.size();
+    srecRecord(text, 0, 0, (const unsigned char *)"68KPROG   " "20" "CREATED BY EASY68K", 30);
+    srecRanges(text, image.data(), &range, 1, SREC_LENGTH);
+    srecRecord(text, 8, 0, NULL, 0);
+    f = fopen(srecName.c_str(), "w");
+    if (!f || fwrite(text.data(), 1, text.size(), f) != text.size()) {
+      linkError(srecName.c_str(), "can't write the file", NULL);
+      exit(1);
+    }
+    fclose(f);
+  }
+
+  if (map) {
+    printf("Section  Address   Size      Module\n");
+    for (s=0; s<RELOC_SECTIONS; s++)
+      for (m=0; m<modules.size(); m++)
+        if (modules[m].sections[s].size)
+          printf("%7d  %08X  %08X  %s\n", s, modules[m].sections[s].addr,
+                 modules[m].sections[s].size, modules[m].name.c_str());
+    printf("\nSymbol                             Value\n");
+    for (m=0; m<modules.size(); m++)
+      for (n=0; n<modules[m].exports.size(); n++) {
+        const string &name = modules[m].exports[n].name;
+        printf("%-33s  %08X%s\n", name.c_str(), symbols[name].address,
+               symbols[name].isAddress ? "" : " (constant)");
+      }
+    printf("\nData space %d bytes, code %d bytes\n", dataSize, (int)image.size());
+  }
+  return 0;
+}
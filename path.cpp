@@ -1,8 +1,9 @@
+#include <string.h>
 #include <filesystem>
 
 using namespace std::filesystem;
 
-static path basePath;
+static thread_local path basePath;
 
 void SetBasePathForFile(const char *pFileName)
 {
@@ -23,8 +23,18 @@ int	processFile(void);
 int	assemble(char *, int *);
 
 int     createCode(char *, int *);
+int     assembleInst(instruction *, char, char *, char *, int *);
 
-int     assembleFile(char fileName[], char tempName[], AnsiString workName);
+int     assembleFile(char fileName[], AnsiString workName);
+
+int     compareEngines(char fileName[]);
+void    addJob(char *fileName, bool compare);
+int     runJobs(int threads);
+void    saveFlags(bool flags[], unsigned int *rules);
+void    loadFlags(const bool flags[], unsigned int rules);
+int     serve(const char *path, int (*command)(int, char **));
+int     serveRequest(const char *path, int argc, char *argv[]);
+const char *servePath();
 
 char    *fieldParse(char *p, opDescriptor *d, int *errorPtr);
 
@@ -115,10 +125,15 @@ int	ds(int, char *, char *, int *);
 int cnop(int size, char* label, char* op, int* errorPtr);
 
 int dataSize(int size, char* label, char* op, int* errorPtr);
+int xdef(int size, char* label, char* op, int* errorPtr);
+int xref(int size, char* label, char* op, int* errorPtr);
 
 int	printError(FILE *, int, int);
 
 char	*eval(char *, exprVal*, bool *, int *);
+void	exprLineStart(char *);
+void	exprPassStart();
+void	clearExprCache();
 
 char	*evalNumber(char *, exprVal*, bool *, int *);
 
@@ -140,9 +155,13 @@ int     listError(char *lineNum, char *errMsg);
 
 int     listText(const char *text);
 
+int     listWrite(const char *text, size_t length);
+
 int	listObj(int, int);
 
 int	strcap(char *, char *);
+void	lineCap(char *, char *);
+int	lineKind(const char *);
 
 char	*skipSpace(char *);
 
@@ -163,6 +182,7 @@ int     macro(int, char *, char *, int *);      //ck
 int     asmMacro(int, char *, char *, int *);   //ck
 
 int     asmStructure(int, char *, char *, int *);  //ck
+void    clearStructured();
 
 int     tokenize(char* , char*, char*[], char*);  //ck
 
@@ -176,8 +196,52 @@ int	initBin(const char*);
 
 int	outputObj(int, int, int);
 
+int	outputObjBytes(int, const unsigned char *, int);
+
+int	outputObjFill(int, int, int, int);
+
 int	outputBin(int, int, int);
 
+int	outputBinBytes(int, const unsigned char *, int);
+
+int	outputBinFill(int, int, int, int);
+
+int	outputBlock(int, int, int);
+
+int	outputBytes(const unsigned char *, int);
+int	emitData(int, int, int);
+int	emitBlock(int, int, int, int);
+int	emitBytes(int, const unsigned char *, int);
+bool	singlePass(void);
+void	fixupLineStart(fixupFrame *, int *);
+void	fixupLineListed(fixupFrame *, bool);
+void	fixupLineEnd(fixupFrame *, char *);
+int	fixupData(int, int, int, int, int, const unsigned char *);
+void	fixupFail(const char *why);
+bool	relaxBranch(int, bool, bool);
+void	relaxStart(void);
+void	relaxPassStart(void);
+bool	relaxAgain(void);
+void	relaxReport(void);
+bool	peephole(flavor *, int, int, opDescriptor *, opDescriptor *, int *);
+bool	optApply(int, int, int);
+bool	optSelect(char *, bool);
+void	optPassStart(void);
+void	optReport(void);
+void	statsStart(void);
+void	statsRestart(void);
+void	statsMark(int);
+void	statsReport(void);
+int	initReloc(const char *);
+void	relocData(int, int, int, int);
+void	relocBytes(int, const unsigned char *, int);
+int	relocImport(char *);
+void	relocExport(char *, const exprVal &);
+bool	relocNeeded(int);
+void	relocPC16(int);
+void	relocAbs(int, int);
+int	finishReloc(void);
+
 int	checkValue(int);
 
 int     finishList();
@@ -190,13 +254,62 @@ char	*opParse(char *, opDescriptor *, int *);
 
 symbolDef *lookup(char *, int, int *);
 
-int	hash(char *);
+unsigned int hash(const char *);
 
 symbolDef* define(char* sym, const exprVal& value, bool pass2, bool check, int* errorPtr);
 
 void clearSymbols();
 
-int	writeObj(void);
+sourceFile *loadSource(const char *path);
+
+bool openSource(sourceReader *reader, const char *path);
+
+bool readLine(sourceReader *reader, char *line);
+
+void clearSources();
+
+void keepSources(bool keep);
+
+void releaseSources();
+
+bool fileState(const char *path, long long *size, long long *mtime);
+
+void clearMacros();
+
+void saveMacro(int index, string &data);
+
+int loadMacro(const char **p, const char *end);
+
+int writeSnapshot(const char *fileName, const char *snapName);
+
+bool loadSnapshot(const char *path, int *errorPtr);
+
+void keepSnapshots(bool keep);
+
+void precompStart();
+
+void precompDepend(const char *path);
+
+void snapPut(string &data, const void *p, size_t n);
+
+bool snapGet(const char **p, const char *end, void *d, size_t n);
+
+void cycleStart();
+
+void cycleWord(int data, int size);
+
+void cycleEnd(int error);
+
+void cycleLabel(const char *label);
+
+void cyclePassStart();
+
+void cycleReport();
+
+void addMacro(symbolDef *);
+
+symbolDef *macroLookup(const char *, unsigned int);
+
 
 int include(int, char *, char *, int *);
 
@@ -214,4 +327,6 @@ void SetBasePathForFile(const char* pFileName);
 
 void GetFilePath(const char* pFileName, char* pFullName);
 
-exprVal LocExpr();
\ No newline at end of file
+exprVal LocExpr();
+
+string ChangeFileExt(string in, const string& newExt);
\ No newline at end of file
@@ -0,0 +1,59 @@
+/***********************************************************************
+ *
+ *		RELOC.H
+ *		Relocatable Object File Format
+ *
+ *		Written by RELOC.CPP when the assembler is run with
+ *		--relocatable, and read by the linker in link/ld68k.cpp.
+ *		All numbers are big-endian.
+ *
+ *		  magic      4 bytes  RELOC_MAGIC
+ *		  dataSize   long     SIZE directive value, -1 if none
+ *		  sections   word     count, then for each section:
+ *		    number   word       section number 0-15
+ *		    size     long       bytes of code and space
+ *		    code     size bytes
+ *		  exports    word     count, then for each XDEF symbol:
+ *		    name     byte length, then the characters
+ *		    section  word       section of a label, or RELOC_ABSOLUTE
+ *		    value    long       offset in the section, or the value
+ *		  imports    word     count, then for each XREF symbol:
+ *		    name     byte length, then the characters
+ *		  relocs     long     count, then for each relocation:
+ *		    section  word       section holding the field
+ *		    offset   long       offset of the field in its section
+ *		    type     word       RELOC_PC16, RELOC_ABS16 or RELOC_ABS32
+ *		    target   word       section of this module, or
+ *		                        RELOC_IMPORT + number of an import
+ *
+ *		A RELOC_PC16 field holds the offset of the address it
+ *		refers to from the start of the target. The linker adds
+ *		the address of the target and subtracts the address of
+ *		the field itself, which gives the displacement of a PC
+ *		relative operand or a word branch.
+ *
+ *		A RELOC_ABS16 or RELOC_ABS32 field holds a number to add
+ *		to an imported constant, such as a QDOS vector defined
+ *		with EQU and XDEF in another module. The linker adds the
+ *		value of the constant, which gives an immediate operand,
+ *		an absolute address or DC data. The target of these is
+ *		always an import, and never an address, as the program
+ *		may be loaded anywhere.
+ *
+ *		The linker puts section 0 of every module first, in the
+ *		order the modules are given, then section 1 and so on.
+ *
+ ************************************************************************/
+#ifndef relocH
+#define relocH
+
+#define RELOC_MAGIC     "R68\x01"
+#define RELOC_PC16      1       // 16 bit PC relative displacement
+#define RELOC_ABS16     2       // 16 bit imported constant
+#define RELOC_ABS32     3       // 32 bit imported constant
+#define RELOC_SECTIONS  16      // sections 0-15
+#define RELOC_IMPORT    16      // target of an external symbol: RELOC_IMPORT + import number
+#define RELOC_ABSOLUTE  0xFFFF  // section of an exported constant
+#define RELOC_NONE      (-1)    // section of an absolute value (opDescriptor)
+
+#endif
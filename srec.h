@@ -0,0 +1,41 @@
+/***********************************************************************
+ *
+ *		SREC.H
+ *		S-Record Writer
+ *
+ *		Used by OBJECT.CPP for the .S68 file of the assembler
+ *		and by link/ld68k.cpp to write a linked image as
+ *		S-records. The records are built in a string from
+ *		ranges of bytes held in memory, so the caller writes
+ *		the whole file with one fwrite().
+ *
+ *		srecRecord() appends one record of the given type
+ *		(S0-S3, S5, S7-S9) with the address field that type
+ *		has. srecRanges() appends the data records for each
+ *		range, length data bytes to a record, as S1 records if
+ *		the whole range is below $10000, S2 if below $1000000
+ *		and S3 otherwise.
+ *
+ ************************************************************************/
+#ifndef srecH
+#define srecH
+
+#include <stddef.h>
+#include <string>
+
+#define SREC_LENGTH     32      // data bytes in an S1-S3 record unless asked otherwise
+#define SREC_MAX_LENGTH 250     // most data bytes an S3 record can hold
+
+// length bytes from offset in the image, loaded at addr
+struct srecRange {
+  unsigned int addr;
+  size_t offset;
+  size_t length;
+};
+
+void srecRecord(std::string &out, int type, unsigned int addr,
+                const unsigned char *data, int count);
+void srecRanges(std::string &out, const unsigned char *image,
+                const srecRange *ranges, size_t count, int length);
+
+#endif